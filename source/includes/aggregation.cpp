@@ -1,11 +1,25 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/builder/basic/kvp.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
 #include <mongocxx/client.hpp>
+#include <mongocxx/exception/exception.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/pipeline.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
 
 using bsoncxx::builder::basic::kvp;
@@ -54,4 +68,188 @@ int main() {
         std::cout << bsoncxx::to_json(result) << std::endl;
         // end-explain
     }
+
+    {
+        // Explains a sample of find operations and records plan problems for each query shape
+        // start-plan-advisor
+        mongocxx::pool pool{uri};
+        auto entry = pool.acquire();
+        auto restaurants = (*entry)["sample_restaurants"]["restaurants"];
+
+        // Sets the fraction of operations to explain. This example explains every operation
+        // so that it prints findings. In production, use a small value such as 0.01.
+        const double sample_rate = 1.0;
+
+        struct explain_request {
+            std::string shape;
+            bsoncxx::document::value command;
+        };
+
+        std::mutex mutex;
+        std::condition_variable requested;
+        std::deque<explain_request> requests;
+        bool stopping = false;
+
+        // Written only by the explain thread, and read after the thread exits
+        std::map<std::string, std::set<std::string>> findings;
+
+        // Collects the name of every stage in the plans that the server ran
+        std::function<void(bsoncxx::document::view, std::set<std::string>&)> collect_stages =
+            [&](bsoncxx::document::view plan, std::set<std::string>& stages) {
+                for (auto&& field : plan) {
+                    if (field.key() == "rejectedPlans") {
+                        continue;
+                    }
+                    if (field.key() == "stage" && field.type() == bsoncxx::type::k_string) {
+                        stages.emplace(field.get_string().value);
+                    } else if (field.type() == bsoncxx::type::k_document) {
+                        collect_stages(field.get_document().value, stages);
+                    } else if (field.type() == bsoncxx::type::k_array) {
+                        for (auto&& item : field.get_array().value) {
+                            if (item.type() == bsoncxx::type::k_document) {
+                                collect_stages(item.get_document().value, stages);
+                            }
+                        }
+                    }
+                }
+            };
+
+        auto as_int64 = [](bsoncxx::document::element field) -> std::int64_t {
+            return field.type() == bsoncxx::type::k_int32 ? field.get_int32().value : field.get_int64().value;
+        };
+
+        // Returns the execution statistics of a find or aggregate explain result. When the
+        // server runs part of a pipeline in a $cursor stage, the statistics appear in that stage.
+        auto execution_stats = [](bsoncxx::document::view result) -> bsoncxx::stdx::optional<bsoncxx::document::view> {
+            if (auto stats = result["executionStats"]) {
+                return stats.get_document().value;
+            }
+            if (auto stages = result["stages"]) {
+                if (auto stats = stages.get_array().value[0]["$cursor"]["executionStats"]) {
+                    return stats.get_document().value;
+                }
+            }
+            return {};
+        };
+
+        // Runs queued explain commands on a separate thread with its own client
+        std::thread explainer([&] {
+            auto client = pool.acquire();
+            auto explain_db = (*client)["sample_restaurants"];
+
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                requested.wait(lock, [&] { return stopping || !requests.empty(); });
+                if (requests.empty()) {
+                    return;
+                }
+                auto request = std::move(requests.front());
+                requests.pop_front();
+                lock.unlock();
+
+                try {
+                    auto result = explain_db.run_command(request.command.view());
+                    auto& shape_findings = findings[request.shape];
+
+                    std::set<std::string> stages;
+                    collect_stages(result.view(), stages);
+                    if (stages.count("COLLSCAN")) {
+                        shape_findings.emplace("collection scan");
+                    }
+                    if (stages.count("SORT")) {
+                        shape_findings.emplace("in-memory sort");
+                    }
+
+                    if (auto stats = execution_stats(result.view())) {
+                        auto examined = as_int64((*stats)["totalDocsExamined"]);
+                        auto returned = as_int64((*stats)["nReturned"]);
+                        // Treats a query that returns no documents as if it returned one
+                        if (examined > 100 * std::max<std::int64_t>(returned, 1)) {
+                            shape_findings.emplace("examines over 100 documents per returned document");
+                        }
+                    }
+                } catch (const mongocxx::exception& e) {
+                    std::cerr << "Explain failed: " << e.what() << std::endl;
+                }
+                lock.lock();
+            }
+        });
+
+        // Builds the shape of a query filter by replacing each value with 1
+        auto filter_shape = [](bsoncxx::document::view filter) {
+            bsoncxx::builder::basic::document shape;
+            for (auto&& field : filter) {
+                shape.append(kvp(field.key(), 1));
+            }
+            return bsoncxx::to_json(shape.view());
+        };
+
+        std::mt19937 generator{std::random_device{}()};
+        std::bernoulli_distribution sampled{sample_rate};
+
+        // Queues an explain command without waiting for it to run
+        auto submit = [&](std::string shape, bsoncxx::document::view explained) {
+            auto command = make_document(kvp("explain", explained), kvp("verbosity", "executionStats"));
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(explain_request{std::move(shape), std::move(command)});
+            requested.notify_one();
+        };
+
+        auto find_sampled = [&](bsoncxx::document::view filter) {
+            if (sampled(generator)) {
+                submit("find " + filter_shape(filter),
+                       make_document(kvp("find", "restaurants"), kvp("filter", filter)).view());
+            }
+            return restaurants.find(filter);
+        };
+
+        auto aggregate_sampled = [&](const mongocxx::pipeline& pipeline) {
+            if (sampled(generator)) {
+                std::string shape = "aggregate";
+                for (auto&& stage : pipeline.view_array()) {
+                    auto name = stage.get_document().value.begin()->key();
+                    shape += " " + std::string(name.data(), name.size());
+                    if (name == "$match") {
+                        shape += " " + filter_shape(stage["$match"].get_document().value);
+                    }
+                }
+                submit(shape,
+                       make_document(kvp("aggregate", "restaurants"),
+                                     kvp("pipeline", pipeline.view_array()),
+                                     kvp("cursor", make_document())).view());
+            }
+            return restaurants.aggregate(pipeline);
+        };
+
+        for (auto&& doc : find_sampled(make_document(kvp("name", "Blarney Castle")))) {
+            // Processes each document
+        }
+
+        mongocxx::pipeline pipeline;
+        pipeline.match(make_document(kvp("cuisine", "Bakery"))).sort(make_document(kvp("name", 1)));
+        for (auto&& doc : aggregate_sampled(pipeline)) {
+            // Processes each document
+        }
+
+        // Waits for the queued explain commands to finish
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        requested.notify_one();
+        explainer.join();
+
+        // Prints the findings for each query shape
+        for (const auto& shape : findings) {
+            if (shape.second.empty()) {
+                continue;
+            }
+            std::cout << shape.first << ":";
+            for (const auto& finding : shape.second) {
+                std::cout << " " << finding << ";";
+            }
+            std::cout << std::endl;
+        }
+        // end-plan-advisor
+    }
 }
\ No newline at end of file
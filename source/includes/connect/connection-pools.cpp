@@ -0,0 +1,57 @@
+// start-warm-pool
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <mongocxx/exception/exception.hpp>
+#include <mongocxx/instance.hpp>
+#include <mongocxx/pool.hpp>
+#include <mongocxx/uri.hpp>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+int main()
+{
+    mongocxx::instance instance;
+    const std::size_t max_pool_size = 50;
+    mongocxx::uri uri("mongodb://<hostname>:<port>/?maxPoolSize=" + std::to_string(max_pool_size));
+    mongocxx::pool pool(uri);
+
+    // Holds every warmed client until all threads finish, so warming more clients than
+    // maxPoolSize would block the extra threads forever
+    const std::size_t warm_count = std::min<std::size_t>(10, max_pool_size);
+    std::vector<mongocxx::pool::entry> clients(warm_count);
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> ready{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < warm_count; ++i) {
+        threads.emplace_back([&, i] {
+            clients[i] = pool.acquire();
+            try {
+                (*clients[i])["admin"].run_command(make_document(kvp("ping", 1)));
+                ++ready;
+            } catch (const mongocxx::exception& e) {
+                std::cerr << "Warm-up failed: " << e.what() << std::endl;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::cout << "Warmed " << ready << " of " << warm_count << " clients in "
+              << elapsed.count() << " ms" << std::endl;
+
+    // Returns the warmed clients to the pool
+    clients.clear();
+}
+// end-warm-pool
@@ -22,4 +22,57 @@ int main()
     mongocxx::uri uri("mongodb://<hostname>:<port>/?compressors=zlib&zlibCompressionLevel=1");
     mongocxx::client client(uri);
 }
-// end-zlib-compression
\ No newline at end of file
+// end-zlib-compression
+
+// start-per-workload-compression
+#include <mongocxx/instance.hpp>
+#include <mongocxx/uri.hpp>
+#include <mongocxx/pool.hpp>
+
+int main()
+{
+    mongocxx::instance instance;
+
+    // Compresses large batch reads and bulk writes
+    mongocxx::uri bulk_uri("mongodb://<hostname>:<port>/?compressors=zstd,snappy");
+    mongocxx::pool bulk_pool(bulk_uri);
+
+    // Sends small point reads and writes uncompressed
+    mongocxx::uri point_uri("mongodb://<hostname>:<port>/");
+    mongocxx::pool point_pool(point_uri);
+
+    auto bulk_client = bulk_pool.acquire();
+    auto point_client = point_pool.acquire();
+}
+// end-per-workload-compression
+
+
+// start-batch-compression
+#include <vector>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <mongocxx/instance.hpp>
+#include <mongocxx/uri.hpp>
+#include <mongocxx/client.hpp>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+int main()
+{
+    mongocxx::instance instance;
+    mongocxx::uri uri("mongodb://<hostname>:<port>/?compressors=zstd");
+    mongocxx::client client(uri);
+    auto collection = client["sample_restaurants"]["restaurants"];
+
+    // Sends many small documents in one compressed message
+    std::vector<bsoncxx::document::value> restaurants;
+    restaurants.push_back(make_document(kvp("name", "Mongo's Burgers"), kvp("borough", "Queens")));
+    restaurants.push_back(make_document(kvp("name", "Mongo's Pizza"), kvp("borough", "Brooklyn")));
+    collection.insert_many(restaurants);
+
+    // Leaves batch_size unset so that each getMore reply holds as many
+    // documents as fit in 16 MiB
+    auto cursor = collection.find(make_document(kvp("borough", "Queens")));
+}
+// end-batch-compression
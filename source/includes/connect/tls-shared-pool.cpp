@@ -0,0 +1,31 @@
+#include <thread>
+#include <vector>
+
+#include <mongocxx/instance.hpp>
+#include <mongocxx/options/pool.hpp>
+#include <mongocxx/pool.hpp>
+#include <mongocxx/uri.hpp>
+
+int main()
+{
+    mongocxx::instance instance;
+    mongocxx::options::client client_options;
+    mongocxx::options::tls tls_options;
+
+    tls_options.pem_file("/path/to/file.pem");
+    client_options.tls_opts(tls_options);
+
+    mongocxx::uri uri("mongodb://<hostname>:<port>/?tls=true&maxPoolSize=20");
+    mongocxx::pool pool(uri, mongocxx::options::pool(client_options));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&pool] {
+            auto client = pool.acquire();
+            // Use the client in this thread
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
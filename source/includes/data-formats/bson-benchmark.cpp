@@ -0,0 +1,271 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <bson/bson.h>
+
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/list.hpp>
+#include <bsoncxx/builder/stream/document.hpp>
+#include <bsoncxx/json.hpp>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+using bsoncxx::builder::basic::sub_array;
+using bsoncxx::builder::basic::sub_document;
+
+// Counts allocations made by the benchmark thread in bsoncxx and libbson
+static thread_local bool counting = false;
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+static void* counting_malloc(std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    return std::malloc(size);
+}
+
+static void* counting_calloc(std::size_t count, std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    return std::calloc(count, size);
+}
+
+static void* counting_realloc(void* ptr, std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    return std::realloc(ptr, size);
+}
+
+// Prevents the compiler from removing the benchmarked operations
+static volatile std::size_t sink = 0;
+
+// Runs an operation repeatedly and prints its average time and allocation count
+template <typename Operation>
+void run(const char* name, Operation operation) {
+    const int iterations = 100000;
+    sink = sink + operation();
+
+    counting = true;
+    auto start_allocations = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink = sink + operation();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    auto allocs = allocations - start_allocations;
+    counting = false;
+
+    std::cout << name << ": " << elapsed.count() / iterations << " ns/op, "
+              << static_cast<double>(allocs) / iterations << " allocs/op" << std::endl;
+}
+
+const int nesting_depth = 16;
+const int num_fields = 100;
+
+// Builds a document nested nesting_depth levels deep by using make_document(), which
+// copies each embedded document into its parent
+bsoncxx::document::value make_nested(int depth) {
+    if (depth == 0) {
+        return make_document(kvp("value", depth));
+    }
+    return make_document(kvp("value", depth), kvp("child", make_nested(depth - 1)));
+}
+
+// Builds the same document in place by using sub_document functions
+void append_nested(sub_document doc, int depth) {
+    doc.append(kvp("value", depth));
+    if (depth > 0) {
+        doc.append(kvp("child", [depth](sub_document child) { append_nested(child, depth - 1); }));
+    }
+}
+
+// Builds the same document by using the stream builder. Each level of nesting has a
+// different context type, so the depth is a template parameter.
+template <int depth, typename Context>
+auto stream_nested(Context context) {
+    using namespace bsoncxx::builder::stream;
+    if constexpr (depth == 0) {
+        return context << "value" << depth;
+    } else {
+        return stream_nested<depth - 1>(context << "value" << depth << "child" << open_document) << close_document;
+    }
+}
+
+int main() {
+    bson_mem_vtable_t vtable{};
+    vtable.malloc = counting_malloc;
+    vtable.calloc = counting_calloc;
+    vtable.realloc = counting_realloc;
+    vtable.free = std::free;
+    bson_mem_set_vtable(&vtable);
+
+    // Builds a document with the shape of a document in the sample_restaurants.restaurants collection
+    run("builder::list", [] {
+        bsoncxx::builder::list doc = {
+            "address", {"building", "1007", "coord", {-73.856077, 40.848447}, "street", "Morris Park Ave", "zipcode", "10462"},
+            "borough", "Bronx",
+            "cuisine", "Bakery",
+            "grades", {{"grade", "A", "score", 2}, {"grade", "B", "score", 6}},
+            "name", "Morris Park Bake Shop",
+            "restaurant_id", "30075445"};
+        return doc.view().get_document().value.length();
+    });
+
+    run("make_document", [] {
+        auto doc = make_document(
+            kvp("address", make_document(kvp("building", "1007"),
+                                         kvp("coord", make_array(-73.856077, 40.848447)),
+                                         kvp("street", "Morris Park Ave"),
+                                         kvp("zipcode", "10462"))),
+            kvp("borough", "Bronx"),
+            kvp("cuisine", "Bakery"),
+            kvp("grades", make_array(make_document(kvp("grade", "A"), kvp("score", 2)),
+                                     make_document(kvp("grade", "B"), kvp("score", 6)))),
+            kvp("name", "Morris Park Bake Shop"),
+            kvp("restaurant_id", "30075445"));
+        return doc.view().length();
+    });
+
+    run("basic::document::append", [] {
+        bsoncxx::builder::basic::document builder;
+        builder.append(
+            kvp("address", [](sub_document address) {
+                address.append(kvp("building", "1007"),
+                               kvp("coord", [](sub_array coord) { coord.append(-73.856077, 40.848447); }),
+                               kvp("street", "Morris Park Ave"),
+                               kvp("zipcode", "10462"));
+            }),
+            kvp("borough", "Bronx"),
+            kvp("cuisine", "Bakery"),
+            kvp("grades", [](sub_array grades) {
+                grades.append([](sub_document grade) { grade.append(kvp("grade", "A"), kvp("score", 2)); },
+                              [](sub_document grade) { grade.append(kvp("grade", "B"), kvp("score", 6)); });
+            }),
+            kvp("name", "Morris Park Bake Shop"),
+            kvp("restaurant_id", "30075445"));
+        return builder.extract().view().length();
+    });
+
+    run("stream::document", [] {
+        using namespace bsoncxx::builder::stream;
+        bsoncxx::document::value doc = document{}
+            << "address" << open_document
+                << "building" << "1007"
+                << "coord" << open_array << -73.856077 << 40.848447 << close_array
+                << "street" << "Morris Park Ave"
+                << "zipcode" << "10462"
+            << close_document
+            << "borough" << "Bronx"
+            << "cuisine" << "Bakery"
+            << "grades" << open_array
+                << open_document << "grade" << "A" << "score" << 2 << close_document
+                << open_document << "grade" << "B" << "score" << 6 << close_document
+            << close_array
+            << "name" << "Morris Park Bake Shop"
+            << "restaurant_id" << "30075445"
+            << finalize;
+        return doc.view().length();
+    });
+
+    // Builds a document with many levels of embedded documents
+    run("deep: make_document", [] { return make_nested(nesting_depth).view().length(); });
+
+    run("deep: sub_document", [] {
+        bsoncxx::builder::basic::document builder;
+        builder.append(kvp("value", nesting_depth),
+                       kvp("child", [](sub_document child) { append_nested(child, nesting_depth - 1); }));
+        return builder.extract().view().length();
+    });
+
+    run("deep: stream::document", [] {
+        bsoncxx::builder::stream::document builder;
+        stream_nested<nesting_depth>(bsoncxx::builder::stream::key_context<>{builder});
+        return builder.extract().view().length();
+    });
+
+    // Builds a document with many top-level fields, each holding a small embedded document
+    std::vector<std::string> keys;
+    for (int i = 0; i < num_fields; ++i) {
+        keys.push_back("field" + std::to_string(i));
+    }
+
+    run("wide: make_document", [&] {
+        bsoncxx::builder::basic::document builder;
+        for (int i = 0; i < num_fields; ++i) {
+            builder.append(kvp(keys[i], make_document(kvp("a", i), kvp("b", "value"))));
+        }
+        return builder.extract().view().length();
+    });
+
+    run("wide: sub_document", [&] {
+        bsoncxx::builder::basic::document builder;
+        for (int i = 0; i < num_fields; ++i) {
+            builder.append(kvp(keys[i], [i](sub_document field) { field.append(kvp("a", i), kvp("b", "value")); }));
+        }
+        return builder.extract().view().length();
+    });
+
+    run("wide: stream::document", [&] {
+        using namespace bsoncxx::builder::stream;
+        document builder;
+        for (int i = 0; i < num_fields; ++i) {
+            builder << keys[i] << open_document << "a" << i << "b" << "value" << close_document;
+        }
+        return builder.extract().view().length();
+    });
+
+    auto restaurant = bsoncxx::from_json(R"({
+        "address": {"building": "1007", "coord": [-73.856077, 40.848447], "street": "Morris Park Ave", "zipcode": "10462"},
+        "borough": "Bronx",
+        "cuisine": "Bakery",
+        "grades": [{"grade": "A", "score": 2}, {"grade": "B", "score": 6}],
+        "name": "Morris Park Bake Shop",
+        "restaurant_id": "30075445"
+    })");
+    auto json = bsoncxx::to_json(restaurant.view());
+
+    run("to_json", [&] { return bsoncxx::to_json(restaurant.view()).size(); });
+
+    run("from_json", [&] { return bsoncxx::from_json(json).view().length(); });
+
+    run("iterate fields", [&] {
+        std::size_t count = 0;
+        for (auto&& field : restaurant.view()) {
+            count += field.key().size();
+        }
+        return count;
+    });
+
+    run("look up 3 fields", [&] {
+        auto view = restaurant.view();
+        return view["name"].get_string().value.size() + view["cuisine"].get_string().value.size() +
+               view["restaurant_id"].get_string().value.size();
+    });
+}
@@ -1,5 +1,14 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/builder/list.hpp>
@@ -75,6 +84,40 @@ int main() {
         // end-bson-stream-finalize
     }
 
+    {
+        // Creates a nested BSON document by building each embedded document separately
+        // start-bson-nested-make-document
+        auto schema = make_document(
+            kvp("properties", make_document(
+                kvp("encryptedFieldName", make_document(
+                    kvp("encrypt", make_document(
+                        kvp("bsonType", "string"),
+                        kvp("algorithm", "AEAD_AES_256_CBC_HMAC_SHA_512-Deterministic"))))))),
+            kvp("bsonType", "object"));
+        // end-bson-nested-make-document
+    }
+
+    {
+        // Creates the same nested BSON document by writing each embedded document into its parent
+        // start-bson-sub-document
+        using bsoncxx::builder::basic::sub_document;
+
+        auto schema_builder = bsoncxx::builder::basic::document{};
+        schema_builder.append(
+            kvp("properties", [](sub_document properties) {
+                properties.append(kvp("encryptedFieldName", [](sub_document field) {
+                    field.append(kvp("encrypt", [](sub_document encrypt) {
+                        encrypt.append(kvp("bsonType", "string"),
+                                       kvp("algorithm", "AEAD_AES_256_CBC_HMAC_SHA_512-Deterministic"));
+                    }));
+                }));
+            }),
+            kvp("bsonType", "object"));
+
+        bsoncxx::document::value schema{schema_builder.extract()};
+        // end-bson-sub-document
+    }
+
     {
         // Prints a BSON document
         // start-bson-print
@@ -85,4 +128,196 @@ int main() {
         std::cout << bsoncxx::to_json(course.view()) << std::endl;
         // end-bson-print
     }
+
+    {
+        // Reads several fields from a BSON document in a single pass
+        auto restaurant = make_document(
+            kvp("name", "Blarney Castle"),
+            kvp("borough", "Queens"),
+            kvp("cuisine", "Irish"),
+            kvp("restaurant_id", "40366356"));
+        // start-bson-single-pass
+        bsoncxx::stdx::string_view name, borough, cuisine;
+        for (auto&& field : restaurant.view()) {
+            auto key = field.key();
+            if (key == "name") {
+                name = field.get_string().value;
+            } else if (key == "borough") {
+                borough = field.get_string().value;
+            } else if (key == "cuisine") {
+                cuisine = field.get_string().value;
+            }
+        }
+        // end-bson-single-pass
+
+        // Builds an index of the document's top-level fields
+        // start-bson-field-index
+        std::unordered_map<bsoncxx::stdx::string_view, bsoncxx::document::element> fields;
+        for (auto&& field : restaurant.view()) {
+            fields.emplace(field.key(), field);
+        }
+
+        std::cout << fields.at("cuisine").get_string().value << std::endl;
+        std::cout << fields.at("restaurant_id").get_string().value << std::endl;
+        // end-bson-field-index
+    }
+
+    {
+        // Reads several nested fields from each restaurant document in one pass over each level
+        // start-bson-field-path
+        struct path_node {
+            std::string key;
+            std::vector<path_node> children;
+            int path = -1;  // Index of the path that ends at this node, or -1
+        };
+
+        // Merges dotted paths into a tree in which paths that share a prefix share nodes
+        auto compile_paths = [](const std::vector<std::string>& paths) {
+            path_node root;
+            for (std::size_t i = 0; i < paths.size(); ++i) {
+                path_node* node = &root;
+                std::size_t start = 0;
+                while (true) {
+                    auto end = std::min(paths[i].find('.', start), paths[i].size());
+                    auto key = paths[i].substr(start, end - start);
+                    auto child = std::find_if(node->children.begin(), node->children.end(),
+                                              [&](const path_node& n) { return n.key == key; });
+                    if (child == node->children.end()) {
+                        node->children.push_back(path_node{key, {}, -1});
+                        child = std::prev(node->children.end());
+                    }
+                    node = &*child;
+                    if (end == paths[i].size()) {
+                        break;
+                    }
+                    start = end + 1;
+                }
+                node->path = static_cast<int>(i);
+            }
+            return root;
+        };
+
+        using path_values = std::vector<bsoncxx::stdx::optional<bsoncxx::types::bson_value::view>>;
+
+        // Iterates over the fields of one level once, descending only into fields that
+        // lead to a requested path. Array elements have the keys "0", "1", and so on, so
+        // numeric path segments match them without special handling.
+        std::function<void(bsoncxx::document::view, const path_node&, path_values&)> resolve =
+            [&](bsoncxx::document::view level, const path_node& node, path_values& values) {
+                std::size_t matched = 0;
+                for (auto&& field : level) {
+                    auto child = std::find_if(node.children.begin(), node.children.end(), [&](const path_node& n) {
+                        return bsoncxx::stdx::string_view{n.key} == field.key();
+                    });
+                    if (child == node.children.end()) {
+                        continue;
+                    }
+                    if (child->path >= 0) {
+                        values[static_cast<std::size_t>(child->path)] = field.get_value();
+                    }
+                    if (field.type() == bsoncxx::type::k_document) {
+                        resolve(field.get_document().value, *child, values);
+                    } else if (field.type() == bsoncxx::type::k_array) {
+                        auto array = field.get_array().value;
+                        resolve(bsoncxx::document::view{array.data(), array.length()}, *child, values);
+                    }
+                    // Stops once every key at this level is found, because keys don't repeat
+                    if (++matched == node.children.size()) {
+                        break;
+                    }
+                }
+            };
+
+        auto paths = compile_paths({"address.zipcode", "grades.0.score"});
+
+        auto collection = client["sample_restaurants"]["restaurants"];
+        mongocxx::options::find opts;
+        opts.limit(3);
+        for (auto&& doc : collection.find({}, opts)) {
+            path_values values(2);
+            resolve(doc, paths, values);
+            auto& zipcode = values[0];
+            auto& score = values[1];
+            if (zipcode && zipcode->type() == bsoncxx::type::k_string &&
+                score && score->type() == bsoncxx::type::k_int32) {
+                std::cout << zipcode->get_string().value << ": " << score->get_int32().value << std::endl;
+            }
+        }
+        // end-bson-field-path
+    }
+
+    {
+        // Converts between a C++ struct and BSON by using a table of the struct's fields
+        // start-bson-struct-codec
+        struct restaurant {
+            std::string name;
+            std::string borough;
+            std::int32_t rating;
+        };
+
+        // Lists the BSON key and member pointer of each field, in the order the encoder writes them
+        const auto restaurant_fields = std::make_tuple(
+            std::make_pair("name", &restaurant::name),
+            std::make_pair("borough", &restaurant::borough),
+            std::make_pair("rating", &restaurant::rating));
+
+        auto encode = [](bsoncxx::builder::basic::document& builder, const auto& obj, const auto& fields) {
+            std::apply([&](const auto&... field) {
+                (builder.append(kvp(field.first, obj.*(field.second))), ...);
+            }, fields);
+        };
+
+        auto read_value = [](bsoncxx::document::element element, auto& out) {
+            using type = std::decay_t<decltype(out)>;
+            if constexpr (std::is_same<type, std::string>::value) {
+                out = std::string(element.get_string().value);
+            } else if constexpr (std::is_same<type, std::int32_t>::value) {
+                out = element.get_int32().value;
+            } else {
+                static_assert(!std::is_same<type, type>::value, "read_value() doesn't support this member type");
+            }
+        };
+
+        auto decode = [&](bsoncxx::document::view doc, auto& obj, const auto& fields) {
+            auto in_table = [&](bsoncxx::stdx::string_view key) {
+                return std::apply([&](const auto&... field) { return ((key == field.first) || ...); }, fields);
+            };
+
+            auto it = doc.begin();
+            std::apply([&](const auto&... field) {
+                ([&] {
+                    // Skips fields that the table doesn't list, such as the _id field that
+                    // insert_many() adds at the start of each document
+                    while (it != doc.end() && !in_table(it->key())) {
+                        ++it;
+                    }
+                    // Reads the next field directly if its key is the expected one
+                    if (it != doc.end() && it->key() == field.first) {
+                        read_value(*it, obj.*(field.second));
+                        ++it;
+                    } else if (auto element = doc[field.first]) {
+                        read_value(element, obj.*(field.second));
+                    }
+                }(), ...);
+            }, fields);
+        };
+
+        auto collection = client["sample_restaurants"]["restaurants"];
+
+        std::vector<restaurant> new_restaurants = {{"Mongo's Deli", "Queens", 4}, {"Mongo's Pizza", "Brooklyn", 5}};
+        std::vector<bsoncxx::document::value> docs;
+        for (const auto& r : new_restaurants) {
+            bsoncxx::builder::basic::document builder;
+            encode(builder, r, restaurant_fields);
+            docs.push_back(builder.extract());
+        }
+        collection.insert_many(docs);
+
+        for (auto&& doc : collection.find(make_document(kvp("rating", make_document(kvp("$exists", true)))))) {
+            restaurant r{};
+            decode(doc, r, restaurant_fields);
+            std::cout << r.name << " (" << r.borough << "): " << r.rating << std::endl;
+        }
+        // end-bson-struct-codec
+    }
 }
\ No newline at end of file
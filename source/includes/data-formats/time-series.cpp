@@ -1,10 +1,24 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
 #include <mongocxx/client.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
+#include <mongocxx/exception/exception.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pipeline.hpp>
 #include <mongocxx/uri.hpp>
 
 using bsoncxx::builder::basic::kvp;
@@ -59,4 +73,150 @@ int main() {
         auto result = collection.insert_many(ts_data);
         // end-insert-ts
     }
+
+    {
+        // Buffers precipitation readings and inserts them in large batches, grouped by
+        // location and ordered by time
+        // start-ingest-ts
+        struct reading {
+            std::string location;
+            std::int64_t timestamp_ms;
+            double precipitation_mm;
+        };
+
+        const std::size_t capacity = 100000;
+        const std::size_t batch_size = 10000;
+        std::mutex buffer_mutex;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+        std::deque<reading> buffer;
+        bool closed = false;
+        std::atomic<std::size_t> dropped{0};
+
+        // Waits up to 10 milliseconds for space in the buffer, then drops the reading
+        auto submit = [&](reading r) {
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            if (!not_full.wait_for(lock, std::chrono::milliseconds{10}, [&] { return buffer.size() < capacity; })) {
+                ++dropped;
+                return;
+            }
+            buffer.push_back(std::move(r));
+            not_empty.notify_one();
+        };
+
+        // Only the writer thread uses the client
+        std::thread writer([&] {
+            auto collection = client["precipitation"]["sept2023"];
+            mongocxx::options::insert opts;
+            opts.ordered(false);
+
+            while (true) {
+                std::vector<reading> batch;
+                {
+                    std::unique_lock<std::mutex> lock(buffer_mutex);
+                    not_empty.wait(lock, [&] { return !buffer.empty() || closed; });
+                    if (buffer.empty()) {
+                        break;
+                    }
+                    auto end = buffer.begin() + std::min(batch_size, buffer.size());
+                    batch.assign(std::make_move_iterator(buffer.begin()), std::make_move_iterator(end));
+                    buffer.erase(buffer.begin(), end);
+                }
+                not_full.notify_all();
+
+                std::sort(batch.begin(), batch.end(), [](const reading& a, const reading& b) {
+                    return std::tie(a.location, a.timestamp_ms) < std::tie(b.location, b.timestamp_ms);
+                });
+
+                std::vector<bsoncxx::document::value> docs;
+                docs.reserve(batch.size());
+                for (const auto& r : batch) {
+                    docs.push_back(make_document(kvp("precipitation_mm", r.precipitation_mm),
+                                                 kvp("location", r.location),
+                                                 kvp("timestamp", bsoncxx::types::b_date{std::chrono::milliseconds{r.timestamp_ms}})));
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                std::size_t failed = 0;
+                try {
+                    collection.insert_many(docs, opts);
+                } catch (const mongocxx::bulk_write_exception& e) {
+                    // The server inserts the other documents in an unordered batch, so only the
+                    // documents listed in "writeErrors" are lost. Without a server reply, the
+                    // whole batch is treated as lost.
+                    failed = docs.size();
+                    if (auto reply = e.raw_server_error()) {
+                        auto errors = reply->view()["writeErrors"];
+                        failed = errors ? static_cast<std::size_t>(std::distance(
+                                              errors.get_array().value.begin(), errors.get_array().value.end()))
+                                        : 0;
+                    }
+                } catch (const mongocxx::exception&) {
+                    failed = docs.size();
+                }
+                dropped += failed;
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                std::cout << "Inserted " << docs.size() - failed << " readings in " << elapsed.count() << " ms"
+                          << std::endl;
+            }
+        });
+
+        submit({"New York City", 1694829060000, 0.5});
+        submit({"New York City", 1695594780000, 2.8});
+
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+        writer.join();
+        std::cout << "Dropped readings: " << dropped << std::endl;
+        // end-ingest-ts
+    }
+
+    {
+        // Reads the timestamps and measurements for New York City in September 2023 into
+        // separate arrays
+        auto db = client["precipitation"];
+        auto collection = db["sept2023"];
+        // start-query-ts-arrays
+        auto start = bsoncxx::types::b_date{std::chrono::milliseconds{1693526400000}};
+        auto end = bsoncxx::types::b_date{std::chrono::milliseconds{1696118400000}};
+        auto filter = make_document(
+            kvp("location", "New York City"),
+            kvp("timestamp", make_document(kvp("$gte", start), kvp("$lt", end))));
+
+        mongocxx::options::find opts;
+        opts.projection(make_document(kvp("_id", 0), kvp("timestamp", 1), kvp("precipitation_mm", 1)));
+        opts.sort(make_document(kvp("timestamp", 1)));
+        opts.batch_size(10000);
+
+        std::vector<std::int64_t> timestamps;
+        std::vector<double> values;
+        for (auto&& doc : collection.find(filter.view(), opts)) {
+            timestamps.push_back(doc["timestamp"].get_date().to_int64());
+            values.push_back(doc["precipitation_mm"].get_double().value);
+        }
+        // end-query-ts-arrays
+
+        // Downsamples the same range on the server to one average value per day
+        // start-query-ts-downsample
+        mongocxx::pipeline stages;
+        stages.match(filter.view())
+              .group(make_document(
+                  kvp("_id", make_document(kvp("$dateTrunc", make_document(
+                      kvp("date", "$timestamp"), kvp("unit", "day"))))),
+                  kvp("precipitation_mm", make_document(kvp("$avg", "$precipitation_mm")))))
+              .sort(make_document(kvp("_id", 1)));
+
+        std::vector<std::int64_t> days;
+        std::vector<double> averages;
+        for (auto&& doc : collection.aggregate(stages)) {
+            days.push_back(doc["_id"].get_date().to_int64());
+            averages.push_back(doc["precipitation_mm"].get_double().value);
+        }
+        std::cout << "Days with data: " << days.size() << std::endl;
+        // end-query-ts-downsample
+    }
 }
\ No newline at end of file
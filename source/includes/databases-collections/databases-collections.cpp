@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 
 #include <bsoncxx/builder/basic/document.hpp>
@@ -133,4 +134,42 @@ int main() {
         mongocxx::client client(uri);
         // end-local-threshold
     }
+
+    {
+        // Instructs the driver to read only from the lowest-latency secondaries that
+        // lag the primary by at most 90 seconds
+        // start-latency-routing
+        mongocxx::uri uri("mongodb://localhost:27017/?localThresholdMS=5&heartbeatFrequencyMS=5000");
+        mongocxx::client client(uri);
+
+        mongocxx::read_preference rp;
+        rp.mode(mongocxx::read_preference::read_mode::k_secondary);
+        rp.max_staleness(std::chrono::seconds{90});
+
+        auto coll = client["test_database"]["test_collection"];
+        coll.read_preference(rp);
+        // end-latency-routing
+    }
+
+    {
+        // Instructs mongos to send secondary reads to two eligible members and return
+        // the first response
+        // start-hedged-reads
+        mongocxx::read_preference rp;
+        rp.mode(mongocxx::read_preference::read_mode::k_secondary_preferred);
+        rp.hedge(make_document(kvp("enabled", true)));
+
+        auto coll = client["test_database"]["test_collection"];
+        coll.read_preference(rp);
+        // end-hedged-reads
+    }
+
+    {
+        // Prints the hedged read metrics that mongos reports
+        // start-hedging-metrics
+        auto status = client["admin"].run_command(make_document(kvp("serverStatus", 1)));
+        auto metrics = status.view()["hedgingMetrics"].get_document().value;
+        std::cout << bsoncxx::to_json(metrics) << std::endl;
+        // end-hedging-metrics
+    }
 }
\ No newline at end of file
@@ -1,9 +1,25 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/options/apm.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
 
 using bsoncxx::builder::basic::kvp;
@@ -51,6 +67,157 @@ int main(){
         // end-index-compound-query 
     }
 
+    {
+        // Records the query shape of each find command and proposes compound indexes that
+        // follow the equality, sort, range rule
+        // start-index-recommend
+        struct shape_stats {
+            std::int64_t count = 0;
+            std::int64_t total_micros = 0;
+        };
+        std::map<std::string, shape_stats> shapes;    // Keyed by proposed index, as JSON
+        std::map<std::int64_t, std::string> pending;  // Maps request IDs to proposed indexes
+
+        auto is_range = [](bsoncxx::document::element value) {
+            if (value.type() != bsoncxx::type::k_document) {
+                return false;
+            }
+            for (auto&& op : value.get_document().value) {
+                auto name = op.key();
+                if (name == "$gt" || name == "$gte" || name == "$lt" || name == "$lte" ||
+                    name == "$ne" || name == "$nin" || name == "$regex") {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        mongocxx::options::apm apm_opts;
+        apm_opts.on_command_started([&](const mongocxx::events::command_started_event& event) {
+            if (event.command_name() != "find") {
+                return;
+            }
+            auto command = event.command();
+
+            bsoncxx::builder::basic::document index;
+            std::set<std::string> indexed;
+            auto add_field = [&](bsoncxx::stdx::string_view name, bsoncxx::types::bson_value::view direction) {
+                if (indexed.emplace(name).second) {
+                    index.append(kvp(name, direction));
+                }
+            };
+
+            // Equality fields first, then sort fields, then range fields
+            std::vector<std::string> range_fields;
+            if (auto filter = command["filter"]) {
+                for (auto&& field : filter.get_document().value) {
+                    if (field.key().empty() || field.key()[0] == '$') {
+                        continue;
+                    }
+                    if (is_range(field)) {
+                        range_fields.emplace_back(field.key());
+                    } else {
+                        add_field(field.key(), bsoncxx::types::bson_value::view{bsoncxx::types::b_int32{1}});
+                    }
+                }
+            }
+            if (auto sort = command["sort"]) {
+                for (auto&& field : sort.get_document().value) {
+                    add_field(field.key(), field.get_value());
+                }
+            }
+            for (const auto& name : range_fields) {
+                add_field(name, bsoncxx::types::bson_value::view{bsoncxx::types::b_int32{1}});
+            }
+
+            if (!indexed.empty()) {
+                auto proposed = bsoncxx::to_json(index.view());
+                ++shapes[proposed].count;
+                pending[event.request_id()] = proposed;
+            }
+        });
+        apm_opts.on_command_succeeded([&](const mongocxx::events::command_succeeded_event& event) {
+            auto it = pending.find(event.request_id());
+            if (it != pending.end()) {
+                shapes[it->second].total_micros += event.duration();
+                pending.erase(it);
+            }
+        });
+        apm_opts.on_command_failed([&](const mongocxx::events::command_failed_event& event) {
+            pending.erase(event.request_id());
+        });
+
+        mongocxx::options::client client_opts;
+        client_opts.apm_opts(apm_opts);
+        mongocxx::client monitored_client(uri, client_opts);
+        auto movies = monitored_client["sample_mflix"]["movies"];
+
+        // Runs the application's queries
+        mongocxx::options::find opts;
+        opts.sort(make_document(kvp("year", -1)));
+        for (auto&& doc : movies.find(make_document(kvp("genres", "Drama"),
+                                                     kvp("runtime", make_document(kvp("$lt", 90)))), opts)) {
+        }
+
+        // Returns true if the fields of "prefix" are the leading fields of "index"
+        auto is_prefix = [](bsoncxx::document::view prefix, bsoncxx::document::view index) {
+            auto it = index.begin();
+            for (auto&& field : prefix) {
+                if (it == index.end() || it->key() != field.key()) {
+                    return false;
+                }
+                ++it;
+            }
+            return true;
+        };
+
+        // Stores the key of each existing index, and whether dropping the index is safe to
+        // consider because it has no options such as "unique", "sparse", or "collation"
+        std::vector<std::pair<bsoncxx::document::value, bool>> existing;
+        for (auto&& index : movies.list_indexes()) {
+            bool plain = index["name"].get_string().value != "_id_";
+            for (auto&& option : index) {
+                if (option.key() != "v" && option.key() != "key" && option.key() != "name") {
+                    plain = false;
+                }
+            }
+            existing.emplace_back(bsoncxx::document::value{index["key"].get_document().value}, plain);
+        }
+
+        // Proposes indexes in order of the total time spent on their query shapes
+        std::vector<std::pair<std::string, shape_stats>> ranked(shapes.begin(), shapes.end());
+        std::sort(ranked.begin(), ranked.end(), [](const std::pair<std::string, shape_stats>& a,
+                                                   const std::pair<std::string, shape_stats>& b) {
+            return a.second.total_micros > b.second.total_micros;
+        });
+        for (const auto& entry : ranked) {
+            auto proposed = bsoncxx::from_json(entry.first);
+            bool covered = std::any_of(existing.begin(), existing.end(),
+                                       [&](const std::pair<bsoncxx::document::value, bool>& index) {
+                                           return is_prefix(proposed.view(), index.first.view());
+                                       });
+            if (!covered) {
+                std::cout << "Proposed index: " << entry.first << " (" << entry.second.count
+                          << " queries, " << entry.second.total_micros << " us)" << std::endl;
+            }
+        }
+
+        // Reports existing indexes without options that are a prefix of another existing index
+        for (const auto& index : existing) {
+            if (!index.second) {
+                continue;
+            }
+            for (const auto& other : existing) {
+                if (&index != &other && is_prefix(index.first.view(), other.first.view()) &&
+                    index.first.view().length() < other.first.view().length()) {
+                    std::cout << "Redundant index: " << bsoncxx::to_json(index.first.view()) << std::endl;
+                    break;
+                }
+            }
+        }
+        // end-index-recommend
+    }
+
     {
         // start-remove-index
         collection.indexes().drop_one("title_1");
@@ -68,6 +235,92 @@ int main(){
         collection.indexes().drop_one("*");
         // end-remove-all-wildcard    
     }
+
+    {
+        // Waits for replication lag to drop below 10 seconds, builds two indexes in a single
+        // createIndexes command, and reports the build progress
+        // start-index-build-managed
+        const auto max_lag = std::chrono::milliseconds{10000};
+        const auto max_latency = std::chrono::microseconds{20000};
+
+        // Returns how far the slowest secondary is behind the primary
+        auto replication_lag = [&]() {
+            auto status = client["admin"].run_command(make_document(kvp("replSetGetStatus", 1)));
+            std::chrono::milliseconds primary{0};
+            std::chrono::milliseconds oldest = std::chrono::milliseconds::max();
+            for (auto&& member : status.view()["members"].get_array().value) {
+                auto optime = member["optimeDate"].get_date().value;
+                auto state = member["stateStr"].get_string().value;
+                if (state == "PRIMARY") {
+                    primary = optime;
+                } else if (state == "SECONDARY") {
+                    oldest = std::min(oldest, optime);
+                }
+            }
+            return oldest == std::chrono::milliseconds::max() ? std::chrono::milliseconds{0} : primary - oldest;
+        };
+
+        // Returns the average latency of the reads and writes that the primary completed
+        // during a 5-second interval
+        auto operation_latency = [&]() {
+            auto totals = [&]() {
+                auto status = client["admin"].run_command(make_document(kvp("serverStatus", 1)));
+                auto latencies = status.view()["opLatencies"];
+                std::int64_t micros = 0;
+                std::int64_t ops = 0;
+                for (auto name : {"reads", "writes"}) {
+                    micros += latencies[name]["latency"].get_int64().value;
+                    ops += latencies[name]["ops"].get_int64().value;
+                }
+                return std::make_pair(micros, ops);
+            };
+            auto before = totals();
+            std::this_thread::sleep_for(std::chrono::seconds{5});
+            auto after = totals();
+            auto ops = after.second - before.second;
+            return std::chrono::microseconds{ops == 0 ? 0 : (after.first - before.first) / ops};
+        };
+
+        while (replication_lag() > max_lag || operation_latency() > max_latency) {
+            std::this_thread::sleep_for(std::chrono::seconds{30});
+        }
+
+        std::vector<mongocxx::index_model> models;
+        models.emplace_back(make_document(kvp("genres", 1), kvp("year", -1)));
+        models.emplace_back(make_document(kvp("directors", 1)));
+
+        // Builds the indexes on a separate thread, because create_many() blocks until the build completes
+        mongocxx::pool pool(uri);
+        std::atomic<bool> done{false};
+        std::exception_ptr build_error;
+        std::thread build([&] {
+            try {
+                auto build_client = pool.acquire();
+                (*build_client)["sample_mflix"]["movies"].indexes().create_many(models);
+            } catch (...) {
+                // Stores the error so that the main thread can rethrow it
+                build_error = std::current_exception();
+            }
+            done = true;
+        });
+
+        auto in_progress = make_document(
+            kvp("currentOp", true),
+            kvp("command.createIndexes", "movies"),
+            kvp("msg", make_document(kvp("$exists", true))));
+        while (!done) {
+            auto ops = client["admin"].run_command(in_progress.view());
+            for (auto&& op : ops.view()["inprog"].get_array().value) {
+                std::cout << op["msg"].get_string().value << std::endl;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds{5});
+        }
+        build.join();
+        if (build_error) {
+            std::rethrow_exception(build_error);
+        }
+        // end-index-build-managed
+    }
     {
         // start-create-static-search-index
         // Create an index model with your index name and definition containing the fields you want to index
@@ -154,5 +407,124 @@ int main(){
         siv.drop_one("myDynamicIndex");
         // end-remove-search-index
     }
+    {
+        // Applies only the changes needed to make the collection's Atlas Search indexes match
+        // the desired definitions, then waits for the indexes to be ready
+        // start-sync-search-indexes
+        std::map<std::string, bsoncxx::document::value> desired;
+        desired.emplace("myDynamicIndex", make_document(kvp("mappings", make_document(kvp("dynamic", true)))));
+        desired.emplace("myStaticIndex", make_document(kvp("mappings", make_document(
+            kvp("dynamic", false),
+            kvp("fields", make_document(kvp("year", make_document(kvp("type", "number")))))))));
+
+        auto is_number = [](bsoncxx::types::bson_value::view value) {
+            return value.type() == bsoncxx::type::k_int32 || value.type() == bsoncxx::type::k_int64 ||
+                   value.type() == bsoncxx::type::k_double;
+        };
+        auto as_double = [](bsoncxx::types::bson_value::view value) {
+            switch (value.type()) {
+                case bsoncxx::type::k_int32:
+                    return static_cast<double>(value.get_int32().value);
+                case bsoncxx::type::k_int64:
+                    return static_cast<double>(value.get_int64().value);
+                default:
+                    return value.get_double().value;
+            }
+        };
+
+        // Returns true if every field that "wanted" sets has the same value in "actual",
+        // regardless of field order. Fields that only "actual" contains, such as default
+        // values that Atlas fills in, are ignored.
+        std::function<bool(bsoncxx::types::bson_value::view, bsoncxx::types::bson_value::view)> matches =
+            [&](bsoncxx::types::bson_value::view wanted, bsoncxx::types::bson_value::view actual) {
+                if (wanted.type() == bsoncxx::type::k_document && actual.type() == bsoncxx::type::k_document) {
+                    auto actual_fields = actual.get_document().value;
+                    for (auto&& field : wanted.get_document().value) {
+                        auto other = actual_fields[field.key()];
+                        if (!other || !matches(field.get_value(), other.get_value())) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+                if (wanted.type() == bsoncxx::type::k_array && actual.type() == bsoncxx::type::k_array) {
+                    auto actual_items = actual.get_array().value;
+                    auto it = actual_items.begin();
+                    for (auto&& item : wanted.get_array().value) {
+                        if (it == actual_items.end() || !matches(item.get_value(), it->get_value())) {
+                            return false;
+                        }
+                        ++it;
+                    }
+                    return it == actual_items.end();
+                }
+                if (is_number(wanted) && is_number(actual)) {
+                    return as_double(wanted) == as_double(actual);
+                }
+                return wanted == actual;
+            };
+
+        // Maps the name of each existing index to its definition
+        std::map<std::string, bsoncxx::document::value> current;
+        for (auto&& index : siv.list()) {
+            current.emplace(std::string(index["name"].get_string().value),
+                            bsoncxx::document::value{index["latestDefinition"].get_document().value});
+        }
+
+        // Names of the indexes that this run creates or updates
+        std::set<std::string> changed;
+        std::vector<mongocxx::search_index_model> to_create;
+        for (const auto& entry : desired) {
+            auto existing = current.find(entry.first);
+            if (existing == current.end()) {
+                to_create.emplace_back(entry.first, entry.second.view());
+                changed.insert(entry.first);
+            } else if (!matches(bsoncxx::types::bson_value::view{bsoncxx::types::b_document{entry.second.view()}},
+                                bsoncxx::types::bson_value::view{bsoncxx::types::b_document{existing->second.view()}})) {
+                siv.update_one(entry.first, entry.second.view());
+                changed.insert(entry.first);
+            }
+        }
+        if (!to_create.empty()) {
+            siv.create_many(to_create);
+        }
+        for (const auto& entry : current) {
+            if (desired.find(entry.first) == desired.end()) {
+                siv.drop_one(entry.first);
+            }
+        }
+
+        // Checks the status of the created and updated indexes, doubling the wait between
+        // checks up to 60 seconds, and gives up after 30 minutes
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes{30};
+        auto delay = std::chrono::seconds{1};
+        while (!changed.empty()) {
+            std::size_t ready = 0;
+            for (auto&& index : siv.list()) {
+                auto name = std::string(index["name"].get_string().value);
+                if (!changed.count(name)) {
+                    continue;
+                }
+                auto status = index["status"].get_string().value;
+                if (status == "FAILED") {
+                    throw std::runtime_error("Search index " + name + " failed to build");
+                }
+                // Right after update_one(), list() can still report the previous definition as READY
+                auto wanted = bsoncxx::types::bson_value::view{bsoncxx::types::b_document{desired.at(name).view()}};
+                if (status == "READY" && matches(wanted, index["latestDefinition"].get_value())) {
+                    ++ready;
+                }
+            }
+            if (ready == changed.size()) {
+                break;
+            }
+            if (std::chrono::steady_clock::now() + delay > deadline) {
+                throw std::runtime_error("Timed out waiting for search indexes to become ready");
+            }
+            std::this_thread::sleep_for(delay);
+            delay = std::min(delay * 2, std::chrono::seconds{60});
+        }
+        // end-sync-search-indexes
+    }
 
 }
\ No newline at end of file
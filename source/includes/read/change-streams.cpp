@@ -1,9 +1,19 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
 #include <mongocxx/client.hpp>
+#include <mongocxx/exception/exception.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
 
 using bsoncxx::builder::basic::kvp;
@@ -69,5 +79,111 @@ int main() {
         }
         // end-change-stream-post-image
     }
+
+    {
+        // Caches the results of find_one() by restaurant name and applies change events on a
+        // separate thread to evict cached documents that change
+        // start-cache-invalidation
+        mongocxx::pool pool{uri};
+
+        std::mutex mutex;
+        std::unordered_map<std::string, bsoncxx::document::value> cache;  // Name to document
+        std::unordered_map<std::string, std::string> names;               // _id to name
+        std::uint64_t generation = 0;  // Incremented by every change event
+        bool watching = false;         // Whether a change stream is open
+        std::condition_variable stream_opened;
+
+        // Empties the cache when the change stream closes or fails, because events might be missed
+        auto reset_cache = [&](bool open) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cache.clear();
+            names.clear();
+            ++generation;
+            watching = open;
+            stream_opened.notify_all();
+        };
+
+        std::atomic<bool> running{true};
+        std::thread watcher([&] {
+            auto client = pool.acquire();
+            auto restaurants = (*client)["sample_restaurants"]["restaurants"];
+            mongocxx::options::change_stream opts;
+            opts.max_await_time(std::chrono::milliseconds{500});
+
+            while (running) {
+                try {
+                    auto stream = restaurants.watch(opts);
+                    reset_cache(true);
+                    while (running) {
+                        bool closed = false;
+                        for (const auto& event : stream) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            ++generation;
+                            auto key = event["documentKey"];
+                            if (!key) {
+                                // Events such as "drop" and "invalidate" close the change stream
+                                closed = true;
+                                break;
+                            }
+                            // The sample_restaurants.restaurants collection uses ObjectId _id values
+                            auto name = names.find(key["_id"].get_oid().value.to_string());
+                            if (name != names.end()) {
+                                cache.erase(name->second);
+                                names.erase(name);
+                            }
+                        }
+                        if (closed) {
+                            break;
+                        }
+                    }
+                } catch (const mongocxx::exception& e) {
+                    std::cerr << "Change stream failed: " << e.what() << std::endl;
+                    std::this_thread::sleep_for(std::chrono::seconds{1});
+                }
+                reset_cache(false);
+            }
+        });
+
+        auto client = pool.acquire();
+        auto restaurants = (*client)["sample_restaurants"]["restaurants"];
+
+        auto find_restaurant = [&](const std::string& name) -> bsoncxx::stdx::optional<bsoncxx::document::value> {
+            std::uint64_t start;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto cached = cache.find(name);
+                if (cached != cache.end()) {
+                    return bsoncxx::document::value{cached->second.view()};
+                }
+                start = generation;
+            }
+
+            auto result = restaurants.find_one(make_document(kvp("name", name)));
+            if (result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                // Skips caching if a change event arrived during find_one(), because the result
+                // might already be stale
+                if (watching && generation == start) {
+                    cache.emplace(name, bsoncxx::document::value{result->view()});
+                    names[result->view()["_id"].get_oid().value.to_string()] = name;
+                }
+            }
+            return result;
+        };
+
+        // Waits up to 10 seconds for the change stream to open, because results aren't
+        // cached until it does
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stream_opened.wait_for(lock, std::chrono::seconds{10}, [&] { return watching; });
+        }
+
+        auto first = find_restaurant("Blarney Castle");   // Reads from the server
+        auto second = find_restaurant("Blarney Castle");  // Reads from the cache
+
+        running = false;
+        watcher.join();
+        // end-cache-invalidation
+    }
     
 }
\ No newline at end of file
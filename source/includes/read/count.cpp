@@ -1,8 +1,16 @@
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <iostream>
+#include <vector>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <mongocxx/client.hpp>
+#include <mongocxx/exception/exception.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pipeline.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
 
 using bsoncxx::builder::basic::kvp;
@@ -61,4 +69,122 @@ int main() {
         std::cout << "Estimated number of documents: " << result << std::endl;
         // end-modify-estimate
     }
+
+    {
+        // Counts documents that have a "founded_year" value of 2010 by splitting the
+        // collection into _id ranges and counting the ranges in parallel
+        // start-count-parallel
+        mongocxx::pool pool(uri);
+        const std::int32_t num_ranges = 8;
+
+        // Samples 100 _id values per range and uses every 100th value as a range boundary,
+        // skipping repeated values because $sample can return the same document more than once
+        mongocxx::pipeline sample;
+        sample.sample(100 * num_ranges)
+            .project(make_document(kvp("_id", 1)))
+            .sort(make_document(kvp("_id", 1)));
+
+        std::vector<bsoncxx::document::value> sampled;
+        for (auto&& doc : collection.aggregate(sample)) {
+            sampled.emplace_back(doc);
+        }
+
+        std::vector<bsoncxx::document::value> bounds;
+        for (std::int32_t i = 1; i < num_ranges && !sampled.empty(); ++i) {
+            auto& bound = sampled[i * sampled.size() / num_ranges];
+            if (bounds.empty() || bounds.back().view()["_id"].get_value() != bound.view()["_id"].get_value()) {
+                bounds.push_back(bound);
+            }
+        }
+
+        std::vector<std::future<std::int64_t>> counts;
+        for (std::size_t i = 0; i <= bounds.size(); ++i) {
+            bsoncxx::builder::basic::document range;
+            if (i > 0) {
+                range.append(kvp("$gte", bounds[i - 1].view()["_id"].get_value()));
+            }
+            if (i < bounds.size()) {
+                range.append(kvp("$lt", bounds[i].view()["_id"].get_value()));
+            }
+            auto filter = make_document(kvp("founded_year", 2010), kvp("_id", range.extract()));
+
+            counts.push_back(std::async(std::launch::async, [&pool, filter] {
+                mongocxx::options::count opts;
+                opts.max_time(std::chrono::milliseconds{2000});
+                auto client = pool.acquire();
+                return (*client)["sample_training"]["companies"].count_documents(filter.view(), opts);
+            }));
+        }
+
+        std::int64_t total = 0;
+        std::size_t timed_out = 0;
+        for (auto& count : counts) {
+            try {
+                total += count.get();
+            } catch (const mongocxx::operation_exception& e) {
+                // Error code 50 indicates that the operation exceeded its time limit
+                if (e.code().value() != 50) {
+                    throw;
+                }
+                ++timed_out;
+            }
+        }
+
+        if (timed_out == 0) {
+            std::cout << "Number of companies founded in 2010: " << total << std::endl;
+        } else {
+            std::cout << "At least " << total << " companies founded in 2010 (" << timed_out
+                      << " of " << counts.size() << " ranges timed out)" << std::endl;
+        }
+        // end-count-parallel
+    }
+
+    {
+        // Serves the number of documents that have a "founded_year" value of 2010 from a
+        // cached count that is at most 5 seconds out of date
+        // start-count-cached
+        const auto max_staleness = std::chrono::seconds{5};
+        auto filter = make_document(kvp("founded_year", 2010));
+
+        // Opens the change stream before the first count so that no change is missed
+        mongocxx::options::change_stream stream_opts;
+        stream_opts.max_await_time(std::chrono::milliseconds{10});
+        auto stream = collection.watch(stream_opts);
+
+        bsoncxx::stdx::optional<std::int64_t> cached_count;
+        auto counted_at = std::chrono::steady_clock::time_point{};
+        bool changed_since_count = false;
+
+        auto count_founded_2010 = [&]() {
+            bool closed = false;
+            try {
+                for (const auto& event : stream) {
+                    if (event["operationType"].get_string().value == "invalidate") {
+                        closed = true;
+                        break;
+                    }
+                    changed_since_count = true;
+                }
+            } catch (const mongocxx::exception&) {
+                closed = true;
+            }
+
+            // Changes might be missed while the stream is closed, so the cached count can't be trusted
+            if (closed) {
+                stream = collection.watch(stream_opts);
+                cached_count = bsoncxx::stdx::nullopt;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (!cached_count || (changed_since_count && now - counted_at > max_staleness)) {
+                cached_count = collection.count_documents(filter.view());
+                counted_at = now;
+                changed_since_count = false;
+            }
+            return *cached_count;
+        };
+
+        std::cout << "Number of companies founded in 2010: " << count_founded_2010() << std::endl;
+        // end-count-cached
+    }
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <queue>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
@@ -77,4 +81,47 @@ int main() {
         // end-tailable
     }
 
+    {
+        // Merges the sorted results of several collections and prints the first 5 documents
+        // in ascending "name" order
+        // start-merge-cursors
+        const std::int64_t k = 5;
+        std::vector<std::string> names = {"restaurants_east", "restaurants_west", "restaurants_north"};
+
+        mongocxx::options::find opts{};
+        opts.sort(make_document(kvp("name", 1))).limit(k);
+
+        std::vector<mongocxx::cursor> cursors;
+        cursors.reserve(names.size());
+        for (const auto& name : names) {
+            cursors.push_back(db[name].find({}, opts));
+        }
+
+        std::vector<mongocxx::cursor::iterator> positions;
+        for (auto& cursor : cursors) {
+            positions.push_back(cursor.begin());
+        }
+
+        // Orders cursors by the "name" value of their current document, smallest first
+        auto greater = [&](std::size_t a, std::size_t b) {
+            return (*positions[a])["name"].get_string().value > (*positions[b])["name"].get_string().value;
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+        for (std::size_t i = 0; i < cursors.size(); ++i) {
+            if (positions[i] != cursors[i].end()) {
+                heap.push(i);
+            }
+        }
+
+        for (std::int64_t returned = 0; returned < k && !heap.empty(); ++returned) {
+            auto i = heap.top();
+            heap.pop();
+            std::cout << bsoncxx::to_json(*positions[i]) << std::endl;
+            if (++positions[i] != cursors[i].end()) {
+                heap.push(i);
+            }
+        }
+        // end-merge-cursors
+    }
+
 }
\ No newline at end of file
@@ -1,9 +1,18 @@
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <iostream>
+#include <set>
+#include <string>
+#include <vector>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
 #include <mongocxx/client.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pipeline.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
 
 using bsoncxx::builder::basic::kvp;
@@ -58,4 +67,80 @@ int main() {
         }
         // end-distinct-with-comment
     }
+
+    {
+        // Retrieves distinct "borough" field values by splitting the collection into _id
+        // ranges and running distinct() on the ranges in parallel
+        // start-distinct-parallel
+        mongocxx::pool pool(uri);
+        const std::int32_t num_ranges = 8;
+
+        // Samples 100 _id values per range and uses every 100th value as a range boundary,
+        // skipping repeated values because $sample can return the same document more than once
+        mongocxx::pipeline sample;
+        sample.sample(100 * num_ranges)
+            .project(make_document(kvp("_id", 1)))
+            .sort(make_document(kvp("_id", 1)));
+
+        std::vector<bsoncxx::document::value> sampled;
+        for (auto&& doc : collection.aggregate(sample)) {
+            sampled.emplace_back(doc);
+        }
+
+        std::vector<bsoncxx::document::value> bounds;
+        for (std::int32_t i = 1; i < num_ranges && !sampled.empty(); ++i) {
+            auto& bound = sampled[i * sampled.size() / num_ranges];
+            if (bounds.empty() || bounds.back().view()["_id"].get_value() != bound.view()["_id"].get_value()) {
+                bounds.push_back(bound);
+            }
+        }
+
+        std::vector<std::future<std::set<std::string>>> partial_results;
+        for (std::size_t i = 0; i <= bounds.size(); ++i) {
+            bsoncxx::builder::basic::document range;
+            if (i > 0) {
+                range.append(kvp("$gte", bounds[i - 1].view()["_id"].get_value()));
+            }
+            if (i < bounds.size()) {
+                range.append(kvp("$lt", bounds[i].view()["_id"].get_value()));
+            }
+            auto filter = make_document(kvp("_id", range.extract()));
+
+            partial_results.push_back(std::async(std::launch::async, [&pool, filter] {
+                mongocxx::options::distinct opts;
+                opts.max_time(std::chrono::milliseconds{2000});
+                auto client = pool.acquire();
+                std::set<std::string> values;
+                for (auto&& doc : (*client)["sample_restaurants"]["restaurants"].distinct("borough", filter.view(), opts)) {
+                    for (auto&& value : doc["values"].get_array().value) {
+                        values.emplace(value.get_string().value);
+                    }
+                }
+                return values;
+            }));
+        }
+
+        std::set<std::string> boroughs;
+        std::size_t timed_out = 0;
+        for (auto& partial : partial_results) {
+            try {
+                auto values = partial.get();
+                boroughs.insert(values.begin(), values.end());
+            } catch (const mongocxx::operation_exception& e) {
+                // Error code 50 indicates that the operation exceeded its time limit
+                if (e.code().value() != 50) {
+                    throw;
+                }
+                ++timed_out;
+            }
+        }
+        for (const auto& borough : boroughs) {
+            std::cout << borough << std::endl;
+        }
+        if (timed_out > 0) {
+            std::cout << "Incomplete: " << timed_out << " of " << partial_results.size()
+                      << " ranges timed out" << std::endl;
+        }
+        // end-distinct-parallel
+    }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <string>
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
@@ -8,6 +9,7 @@
 
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
+using bsoncxx::builder::basic::make_array;
 
 int main() {
     mongocxx::instance instance;
@@ -71,4 +73,40 @@ int main() {
         }
         // end-limit-sort-skip
     }
+
+    {
+        // Retrieves all documents with a "cuisine" value of "Italian" in pages of 5, sorted by
+        // ascending "name" and "_id" order, by starting each page after the last document
+        // of the previous page
+        // start-keyset-pagination
+        auto fetch_page = [&](const std::string& token) {
+            bsoncxx::builder::basic::document filter;
+            filter.append(kvp("cuisine", "Italian"));
+            if (!token.empty()) {
+                auto last = bsoncxx::from_json(token);
+                auto name = last.view()["name"].get_value();
+                auto id = last.view()["_id"].get_value();
+                filter.append(kvp("$or", make_array(
+                    make_document(kvp("name", make_document(kvp("$gt", name)))),
+                    make_document(kvp("name", name), kvp("_id", make_document(kvp("$gt", id)))))));
+            }
+
+            mongocxx::options::find opts{};
+            opts.sort(make_document(kvp("name", 1), kvp("_id", 1))).limit(5);
+
+            std::string next_token;
+            for (auto&& doc : collection.find(filter.view(), opts)) {
+                std::cout << bsoncxx::to_json(doc) << std::endl;
+                next_token = bsoncxx::to_json(make_document(kvp("name", doc["name"].get_value()),
+                                                            kvp("_id", doc["_id"].get_value())));
+            }
+            return next_token;
+        };
+
+        std::string token;
+        do {
+            token = fetch_page(token);
+        } while (!token.empty());
+        // end-keyset-pagination
+    }
 }
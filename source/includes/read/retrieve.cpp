@@ -1,11 +1,23 @@
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/stdx.hpp>
 #include <mongocxx/uri.hpp>
 
@@ -51,4 +63,116 @@ int main() {
     opts.limit(5);
     auto cursor = collection.find(make_document(kvp("number_of_employees", 1000)), opts);
     // end-modify
+
+    // Shares one find_one() call between threads that request the same filter concurrently
+    // start-coalesce
+    using find_one_result = bsoncxx::stdx::optional<bsoncxx::document::value>;
+
+    mongocxx::pool pool(uri);
+    std::mutex in_flight_mutex;
+    std::map<std::string, std::shared_future<find_one_result>> in_flight;
+
+    auto find_one_shared = [&](bsoncxx::document::view filter) {
+        auto key = bsoncxx::to_json(filter);
+        std::promise<find_one_result> promise;
+        std::shared_future<find_one_result> future;
+        bool is_leader = false;
+        {
+            std::lock_guard<std::mutex> lock(in_flight_mutex);
+            auto it = in_flight.find(key);
+            if (it == in_flight.end()) {
+                future = promise.get_future().share();
+                in_flight.emplace(key, future);
+                is_leader = true;
+            } else {
+                future = it->second;
+            }
+        }
+
+        if (is_leader) {
+            try {
+                auto client = pool.acquire();
+                promise.set_value((*client)["sample_training"]["companies"].find_one(filter));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+            std::lock_guard<std::mutex> lock(in_flight_mutex);
+            in_flight.erase(key);
+        }
+        return future.get();
+    };
+    // end-coalesce
+
+    // Collects find_one() lookups by "name" and runs them as a single find() with $in
+    // start-batch-lookups
+    using find_one_result = bsoncxx::stdx::optional<bsoncxx::document::value>;
+    using lookup_request = std::pair<std::string, std::promise<find_one_result>>;
+
+    std::mutex pending_mutex;
+    std::vector<lookup_request> pending;
+
+    auto lookup = [&](const std::string& name) {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending.emplace_back(name, std::promise<find_one_result>{});
+        return pending.back().second.get_future();
+    };
+
+    auto flush = [&](mongocxx::collection& coll) {
+        std::vector<lookup_request> batch;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            batch.swap(pending);
+        }
+        if (batch.empty()) {
+            return;
+        }
+
+        bsoncxx::builder::basic::array names;
+        for (const auto& request : batch) {
+            names.append(request.first);
+        }
+
+        std::unordered_map<std::string, bsoncxx::document::value> found;
+        try {
+            auto filter = make_document(kvp("name", make_document(kvp("$in", names.view()))));
+            for (auto&& doc : coll.find(filter.view())) {
+                found.emplace(std::string(doc["name"].get_string().value), bsoncxx::document::value{doc});
+            }
+        } catch (...) {
+            for (auto& request : batch) {
+                request.second.set_exception(std::current_exception());
+            }
+            return;
+        }
+
+        for (auto& request : batch) {
+            auto it = found.find(request.first);
+            if (it == found.end()) {
+                request.second.set_value(find_one_result{});
+            } else {
+                request.second.set_value(find_one_result{it->second});
+            }
+        }
+    };
+
+    std::atomic<bool> running{true};
+    std::thread dispatcher([&] {
+        auto client = pool.acquire();
+        auto coll = (*client)["sample_training"]["companies"];
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::microseconds{500});
+            flush(coll);
+        }
+        flush(coll);
+    });
+
+    auto linkedin = lookup("LinkedIn");
+    auto facebook = lookup("Facebook");
+    if (auto doc = linkedin.get()) {
+        std::cout << bsoncxx::to_json(*doc) << std::endl;
+    }
+
+    running = false;
+    dispatcher.join();
+    // end-batch-lookups
 }
@@ -0,0 +1,397 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <bson/bson.h>
+
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/types.hpp>
+
+#include <mongocxx/bulk_write.hpp>
+#include <mongocxx/instance.hpp>
+#include <mongocxx/pipeline.hpp>
+#include <mongocxx/pool.hpp>
+#include <mongocxx/uri.hpp>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+// Counts allocations made by the benchmark thread in the driver, libmongoc, and libbson
+static thread_local bool counting = false;
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+static void* counting_malloc(std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    return std::malloc(size);
+}
+
+static void* counting_calloc(std::size_t count, std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    return std::calloc(count, size);
+}
+
+static void* counting_realloc(void* ptr, std::size_t size) {
+    if (counting) {
+        ++allocations;
+    }
+    return std::realloc(ptr, size);
+}
+
+// Returns a document with the shape of a document in the sample_restaurants.restaurants collection
+bsoncxx::document::value restaurant() {
+    return make_document(
+        kvp("address", make_document(kvp("building", "1007"),
+                                     kvp("coord", make_array(-73.856077, 40.848447)),
+                                     kvp("street", "Morris Park Ave"),
+                                     kvp("zipcode", "10462"))),
+        kvp("borough", "Bronx"),
+        kvp("cuisine", "Bakery"),
+        kvp("grades", make_array(make_document(kvp("grade", "A"), kvp("score", 2)),
+                                 make_document(kvp("grade", "B"), kvp("score", 6)))),
+        kvp("name", "Morris Park Bake Shop"),
+        kvp("restaurant_id", "30075445"));
+}
+
+// Cursor replies that the mock server returns, keyed by the number of documents in the batch.
+// The map is filled before the server starts and is only read afterward.
+static std::map<std::int64_t, bsoncxx::document::value> cursor_replies;
+
+void add_cursor_reply(std::int64_t size) {
+    bsoncxx::builder::basic::array batch;
+    for (std::int64_t i = 0; i < size; ++i) {
+        batch.append(restaurant());
+    }
+    cursor_replies.emplace(size,
+                           make_document(kvp("cursor",
+                                             make_document(kvp("id", std::int64_t{0}),
+                                                           kvp("ns", "sample_restaurants.restaurants"),
+                                                           kvp("firstBatch", batch.extract()))),
+                                         kvp("ok", 1.0)));
+}
+
+std::int64_t as_int64(bsoncxx::document::element element) {
+    return element.type() == bsoncxx::type::k_int32 ? element.get_int32().value : element.get_int64().value;
+}
+
+// Returns the reply to a command. num_documents is the number of documents in the
+// command's document sequence, such as the documents in an insert command.
+bsoncxx::document::value reply_to(bsoncxx::document::view command, std::int32_t num_documents) {
+    auto name = command.begin()->key();
+
+    if (name == "hello" || name == "isMaster" || name == "ismaster") {
+        return make_document(kvp("ok", 1.0),
+                             kvp("helloOk", true),
+                             kvp("isWritablePrimary", true),
+                             kvp("ismaster", true),
+                             kvp("minWireVersion", 0),
+                             kvp("maxWireVersion", 21),
+                             kvp("maxBsonObjectSize", 16 * 1024 * 1024),
+                             kvp("maxMessageSizeBytes", 48000000),
+                             kvp("maxWriteBatchSize", 100000),
+                             kvp("logicalSessionTimeoutMinutes", 30));
+    }
+    if (name == "find") {
+        return cursor_replies.at(as_int64(command["limit"]));
+    }
+    if (name == "aggregate") {
+        auto first_stage = command["pipeline"].get_array().value[0].get_document().value;
+        return cursor_replies.at(as_int64(first_stage["$limit"]));
+    }
+    if (name == "insert" || name == "update" || name == "delete") {
+        return make_document(kvp("n", num_documents), kvp("nModified", 0), kvp("ok", 1.0));
+    }
+    return make_document(kvp("ok", 1.0));
+}
+
+bool read_all(int fd, std::uint8_t* data, std::size_t length) {
+    while (length > 0) {
+        auto n = recv(fd, data, length, 0);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool write_all(int fd, const std::uint8_t* data, std::size_t length) {
+    while (length > 0) {
+        auto n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Wire protocol integers are little-endian, which matches the byte order of x86-64 and ARM64
+std::int32_t read_int32(const std::uint8_t* data) {
+    std::int32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void append_int32(std::vector<std::uint8_t>& buffer, std::int32_t value) {
+    auto bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+}
+
+void send_message(int fd, std::int32_t response_to, std::int32_t op_code, const std::vector<std::uint8_t>& body) {
+    static std::atomic<std::int32_t> next_request_id{1};
+
+    std::vector<std::uint8_t> message;
+    append_int32(message, static_cast<std::int32_t>(16 + body.size()));
+    append_int32(message, next_request_id++);
+    append_int32(message, response_to);
+    append_int32(message, op_code);
+    message.insert(message.end(), body.begin(), body.end());
+    write_all(fd, message.data(), message.size());
+}
+
+// Answers the messages that the driver sends on one connection
+void serve(int fd) {
+    const std::int32_t op_reply = 1;
+    const std::int32_t op_query = 2004;
+    const std::int32_t op_msg = 2013;
+
+    std::vector<std::uint8_t> message;
+    std::vector<std::uint8_t> body;
+    std::uint8_t header[16];
+
+    while (read_all(fd, header, sizeof(header))) {
+        auto length = read_int32(header);
+        auto request_id = read_int32(header + 4);
+        auto op_code = read_int32(header + 12);
+        if (length < 16) {
+            break;
+        }
+
+        message.resize(static_cast<std::size_t>(length) - 16);
+        if (!read_all(fd, message.data(), message.size())) {
+            break;
+        }
+        body.clear();
+
+        if (op_code == op_query) {
+            // Older drivers send the first hello command as an OP_QUERY message
+            auto data = message.data() + 4;
+            data += std::strlen(reinterpret_cast<const char*>(data)) + 1 + 8;
+            auto reply = reply_to(bsoncxx::document::view{data, static_cast<std::size_t>(read_int32(data))}, 0);
+
+            append_int32(body, 0);
+            body.insert(body.end(), 8, 0);
+            append_int32(body, 0);
+            append_int32(body, 1);
+            body.insert(body.end(), reply.view().data(), reply.view().data() + reply.view().length());
+            send_message(fd, request_id, op_reply, body);
+        } else if (op_code == op_msg) {
+            auto flags = read_int32(message.data());
+            auto end = message.size() - ((flags & 1) ? 4 : 0);
+            bsoncxx::document::view command;
+            std::int32_t num_documents = 0;
+
+            for (std::size_t offset = 4; offset < end;) {
+                auto kind = message[offset++];
+                auto section_length = static_cast<std::size_t>(read_int32(message.data() + offset));
+                if (kind == 0) {
+                    command = bsoncxx::document::view{message.data() + offset, section_length};
+                } else {
+                    // Counts the documents in a document sequence, which follow the sequence identifier
+                    auto position = offset + 4;
+                    position += std::strlen(reinterpret_cast<const char*>(message.data() + position)) + 1;
+                    for (; position < offset + section_length; ++num_documents) {
+                        position += static_cast<std::size_t>(read_int32(message.data() + position));
+                    }
+                }
+                offset += section_length;
+            }
+
+            auto reply = reply_to(command, num_documents);
+            append_int32(body, 0);
+            body.push_back(0);
+            body.insert(body.end(), reply.view().data(), reply.view().data() + reply.view().length());
+            send_message(fd, request_id, op_msg, body);
+        }
+    }
+    close(fd);
+}
+
+// Listens on a free loopback port and returns the port number
+std::uint16_t start_server() {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("socket");
+        std::exit(EXIT_FAILURE);
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::perror("bind");
+        std::exit(EXIT_FAILURE);
+    }
+    if (listen(listener, 64) < 0) {
+        std::perror("listen");
+        std::exit(EXIT_FAILURE);
+    }
+
+    socklen_t address_length = sizeof(address);
+    if (getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_length) < 0) {
+        std::perror("getsockname");
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::thread([listener] {
+        for (int fd; (fd = accept(listener, nullptr, nullptr)) >= 0;) {
+            int enabled = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+            std::thread(serve, fd).detach();
+        }
+    }).detach();
+
+    return ntohs(address.sin_port);
+}
+
+// Prevents the compiler from removing the benchmarked operations
+static volatile std::size_t sink = 0;
+
+// Runs an operation repeatedly and prints its average time, allocation count, and throughput
+template <typename Operation>
+void run(const std::string& name, std::int64_t documents_per_op, Operation operation) {
+    const int iterations = 10000;
+    sink = sink + operation();
+
+    counting = true;
+    auto start_allocations = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink = sink + operation();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    auto allocs = allocations - start_allocations;
+    counting = false;
+
+    auto seconds = elapsed.count() / 1e9;
+    std::cout << name << ": " << elapsed.count() / iterations << " ns/op, "
+              << static_cast<double>(allocs) / iterations << " allocs/op, " << iterations / seconds << " ops/s";
+    if (documents_per_op > 0) {
+        std::cout << ", " << iterations * documents_per_op / seconds << " docs/s";
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    bson_mem_vtable_t vtable{};
+    vtable.malloc = counting_malloc;
+    vtable.calloc = counting_calloc;
+    vtable.realloc = counting_realloc;
+    vtable.free = std::free;
+    bson_mem_set_vtable(&vtable);
+
+    const std::vector<std::int64_t> batch_sizes = {1, 100};
+    for (auto size : batch_sizes) {
+        add_cursor_reply(size);
+    }
+    auto port = start_server();
+
+    mongocxx::instance instance;
+    mongocxx::uri uri("mongodb://127.0.0.1:" + std::to_string(port) + "/?directConnection=true");
+    mongocxx::pool pool{uri};
+    auto client = pool.acquire();
+    auto collection = (*client)["sample_restaurants"]["restaurants"];
+
+    run("pool acquire", 0, [&] {
+        auto entry = pool.acquire();
+        return static_cast<std::size_t>(entry ? 1 : 0);
+    });
+
+    auto filter = make_document(kvp("restaurant_id", "30075445"));
+    auto update = make_document(kvp("$set", make_document(kvp("cuisine", "Bakery"))));
+
+    for (auto size : batch_sizes) {
+        auto suffix = " (" + std::to_string(size) + " docs)";
+
+        mongocxx::options::find opts{};
+        opts.limit(size);
+        run("find" + suffix, size, [&] {
+            std::size_t length = 0;
+            for (auto&& doc : collection.find({}, opts)) {
+                length += doc.length();
+            }
+            return length;
+        });
+
+        mongocxx::pipeline pipeline;
+        pipeline.limit(static_cast<std::int32_t>(size));
+        run("aggregate" + suffix, size, [&] {
+            std::size_t length = 0;
+            for (auto&& doc : collection.aggregate(pipeline)) {
+                length += doc.length();
+            }
+            return length;
+        });
+
+        std::vector<bsoncxx::document::value> documents;
+        for (std::int64_t i = 0; i < size; ++i) {
+            documents.push_back(restaurant());
+        }
+        run("insert_many" + suffix, size, [&] {
+            auto result = collection.insert_many(documents);
+            return static_cast<std::size_t>(result ? result->inserted_count() : 0);
+        });
+
+        run("bulk_write" + suffix, size, [&] {
+            auto bulk = collection.create_bulk_write();
+            for (std::int64_t i = 0; i < size; ++i) {
+                bulk.append(mongocxx::model::update_one{filter.view(), update.view()});
+            }
+            auto result = bulk.execute();
+            return static_cast<std::size_t>(result ? result->matched_count() : 0);
+        });
+    }
+}